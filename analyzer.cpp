@@ -0,0 +1,152 @@
+/**
+ * File:    analyzer.cpp
+ * Project: CMSC 341 Project 4 – A DNA Database
+ *
+ * Replays a key set through a DnaDb once per built-in hash function and reports
+ * the home bucket distribution, the probe lengths and the time spent per key
+ *
+ * Usage:   ./analyzer.exe [keyfile]
+ *          keyfile holds one sequence per line, without it overlapping k-mers of a
+ *          random genome are used
+ */
+#include "dnadb.h"
+#include "hashfns.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+const int KMER = 21;                // length of generated k-mers
+const int MAXKEYS = MAXPRIME / 2;   // most keys a DnaDb holds below a load factor of .5
+const int MAXBUCKET = 4;            // bucket loads at or above this are reported together
+
+class Analyzer{
+    public:
+    Analyzer(const vector<string>& sequences);
+    void header() const;
+    void analyze(string name, hash_fn hash) const;
+
+    private:
+    vector<DNA> m_keys;             // keys replayed for every hash
+
+    //private helper functions
+    static double nanoseconds(chrono::steady_clock::time_point start, int count);
+};
+
+int main(int argc, char* argv[]){
+    vector<string> sequences;
+    if(argc > 1){
+        ifstream keyfile(argv[1]);
+        if(!keyfile){
+            cerr << "Cannot open " << argv[1] << endl;
+            return 1;
+        }
+        string sequence;
+        while(keyfile >> sequence){
+            sequences.push_back(sequence);
+        }
+    }else{
+        srand(1);
+        string genome;
+        for(int i = 0; i < MAXKEYS + KMER - 1; i++){
+            genome += ALPHA[rand() % MAX];
+        }
+        for(int i = 0; i < MAXKEYS; i++){
+            sequences.push_back(genome.substr(i, KMER));
+        }
+    }
+    if(sequences.size() > MAXKEYS){
+        cerr << "Only the first " << MAXKEYS << " of " << sequences.size() << " keys fit below MAXPRIME\n";
+        sequences.resize(MAXKEYS);
+    }
+    Analyzer analyzer(sequences);
+    analyzer.header();
+    analyzer.analyze("djb", djbHash);
+    analyzer.analyze("packed", packedHash);
+    analyzer.analyze("crc32c", crc32cHash);
+    analyzer.analyze("wyhash", wyHash);
+}
+
+// Name:    Analyzer (Constructor)
+// Desc:    Constructor for Analyzer
+// Precon:  None
+// Postcon: Every sequence becomes a key, with locations cycling through [MINLOCID,MAXLOCID]
+Analyzer::Analyzer(const vector<string>& sequences){
+    for(int i = 0; i < sequences.size(); i++){
+        m_keys.push_back(DNA(sequences[i], MINLOCID + i % (MAXLOCID - MINLOCID + 1)));
+    }
+}
+
+// Name:    header
+// Desc:    Outputs the column headings of the report
+// Precon:  None
+// Postcon: Headings displayed to user
+void Analyzer::header() const{
+    cout << m_keys.size() << " keys\n"
+         << setw(8) << "hash" << setw(8) << "cap"
+         << setw(8) << "empty%" << setw(7) << "1%" << setw(7) << "2%" << setw(7) << "3%" << setw(7) << "4+%"
+         << setw(8) << "maxLoad" << setw(10) << "avgProbe" << setw(9) << "maxProbe"
+         << setw(10) << "ns/hash" << setw(10) << "ns/ins" << setw(10) << "ns/find" << endl;
+}
+
+// Name:    analyze
+// Desc:    Replays the keys through a DnaDb using hash
+// Precon:  None
+// Postcon: Outputs one row for hash
+//          Bucket percentages are of the buckets holding that many keys' home positions
+//          Probe length counts the buckets DnaDb::getDNA visits to find each key once all keys are inserted
+void Analyzer::analyze(string name, hash_fn hash) const{
+    int count = m_keys.size();
+    volatile unsigned int sink = 0;    // keeps the timed loops from being optimized away
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int i = 0; i < count; i++){
+        sink ^= hash(m_keys[i].m_sequence);
+    }
+    double hashTime = nanoseconds(start, count);
+
+    DnaDb dnadb(MINPRIME, hash);
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < count; i++){
+        dnadb.insert(m_keys[i]);
+    }
+    double insertTime = nanoseconds(start, count);
+    dnadb.finishRehash();
+
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < count; i++){
+        sink ^= dnadb.getDNA(m_keys[i].m_sequence, m_keys[i].m_location).m_location;
+    }
+    double findTime = nanoseconds(start, count);
+
+    unsigned int cap = dnadb.m_currentCap;
+    vector<int> load(cap, 0), buckets(MAXBUCKET + 1, 0);
+    long long totalProbes = 0;
+    int maxProbes = 0, maxLoad = 0;
+    for(int i = 0; i < count; i++){
+        int probes;
+        load[hash(m_keys[i].m_sequence) % cap]++;
+        dnadb.findInCurrent(m_keys[i].m_sequence, m_keys[i].m_location, probes);
+        totalProbes += probes;
+        maxProbes = probes > maxProbes ? probes : maxProbes;
+    }
+    for(int i = 0; i < cap; i++){
+        buckets[load[i] < MAXBUCKET ? load[i] : MAXBUCKET]++;
+        maxLoad = load[i] > maxLoad ? load[i] : maxLoad;
+    }
+
+    cout << fixed << setprecision(1) << setw(8) << name << setw(8) << cap;
+    for(int i = 0; i <= MAXBUCKET; i++){
+        cout << setw(i == 0 ? 8 : 7) << 100.0 * buckets[i] / cap;
+    }
+    cout << setw(8) << maxLoad << setprecision(2) << setw(10) << (double) totalProbes / count
+         << setw(9) << maxProbes << setprecision(1) << setw(10) << hashTime
+         << setw(10) << insertTime << setw(10) << findTime << endl;
+}
+
+// Name:    nanoseconds
+// Desc:    Finds the average time of count operations
+// Precon:  count > 0
+// Postcon: Returns the nanoseconds since start divided by count
+double Analyzer::nanoseconds(chrono::steady_clock::time_point start, int count){
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+}
@@ -11,6 +11,11 @@
  * A DNA consists of a string containing the DNA sequence and an int representing the DNA's location
  */
 #include "dnadb.h"
+#include "hashfns.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cerrno>
 
 // Name:    DnaDb (Constructor)
 // Desc:    Constructor for DnaDb
@@ -18,24 +23,104 @@
 // Postcon: A DnaDb will be created containing empty DNA
 //          The size of the table will be the first prime number >= size within the range [MINPRIME,MAXPRIME]
 DnaDb::DnaDb(int size, hash_fn hash) : m_hash(hash), m_currentSize(0), m_currentCap(findNextPrime(size - 1)),
-        m_currNumDeleted(0), m_oldTable(nullptr), m_oldCap(0), m_oldSize(0), m_oldNumDeleted(0){
+        m_currNumDeleted(0), m_oldTable(nullptr), m_oldCap(0), m_oldSize(0), m_oldNumDeleted(0),
+        m_logFd(-1), m_logSize(0), m_logPending(0), m_logGroup(LOGGROUP), m_ckptInterval(0), m_sinceCkpt(0),
+        m_ckptGen(0), m_logGen(0), m_ckptSize(0), m_ckptFullSize(0), m_dirty(nullptr), m_fullCkpt(true),
+        m_ckptDue(false){
     m_currentTable = new DNA[m_currentCap];
 }
 
+// Name:    DnaDb (Copy Constructor)
+// Desc:    Creates a copy of an existing DnaDb
+// Precon:  None
+// Postcon: this will hold deep copies of rhs's tables and no log,
+//          so only rhs keeps writing to rhs's log
+DnaDb::DnaDb(const DnaDb& rhs) : m_currentTable(nullptr), m_oldTable(nullptr), m_logFd(-1), m_dirty(nullptr){
+    copyFrom(rhs);
+}
+
 // Name:    ~DnaDb (Destructor)
 // Desc:    Destructor for DnaDb
 // Precon:  None
 // Postcon: All dynamically allocated memory will be deallocated
+//          Buffered log records will be written and the log closed
 DnaDb::~DnaDb(){
+    closeLog();
     delete[] m_currentTable;
     delete[] m_oldTable;
 }
 
+// Name:    operator= (Overloaded Assignment Operator)
+// Desc:    Replaces the contents of this with a copy of an existing DnaDb
+// Precon:  this cannot be rhs, else nothing happens
+// Postcon: this will hold deep copies of rhs's tables
+//          Any log attached to this is flushed and closed, and none is attached afterwards
+const DnaDb& DnaDb::operator=(const DnaDb& rhs){
+    if(this != &rhs){
+        closeLog();
+        delete[] m_currentTable;
+        delete[] m_oldTable;
+        copyFrom(rhs);
+    }
+    return *this;
+}
+
+// Name:    copyFrom
+// Desc:    Copies the tables of rhs into this
+// Precon:  this holds no tables and no log
+// Postcon: this will hold deep copies of rhs's tables, with no log attached
+void DnaDb::copyFrom(const DnaDb& rhs){
+    m_hash = rhs.m_hash;
+    m_currentCap = rhs.m_currentCap;
+    m_currentSize = rhs.m_currentSize;
+    m_currNumDeleted = rhs.m_currNumDeleted;
+    m_oldCap = rhs.m_oldCap;
+    m_oldSize = rhs.m_oldSize;
+    m_oldNumDeleted = rhs.m_oldNumDeleted;
+    m_currentTable = new DNA[m_currentCap];
+    for(int i = 0; i < m_currentCap; i++){
+        m_currentTable[i] = rhs.m_currentTable[i];
+    }
+    m_oldTable = nullptr;
+    if(rhs.m_oldTable != nullptr){
+        m_oldTable = new DNA[m_oldCap];
+        for(int i = 0; i < m_oldCap; i++){
+            m_oldTable[i] = rhs.m_oldTable[i];
+        }
+    }
+    m_logFd = -1;
+    m_logPath = m_logBuffer = "";
+    m_logSize = m_logPending = m_ckptInterval = m_sinceCkpt = 0;
+    m_logGroup = LOGGROUP;
+    m_ckptGen = m_logGen = 0;
+    m_ckptSize = m_ckptFullSize = 0;
+    m_dirty = nullptr;
+    m_fullCkpt = true;
+    m_ckptDue = false;
+}
+
+// Name:    closeLog
+// Desc:    Detaches the log from the DnaDb
+// Precon:  None
+// Postcon: Buffered log records will be written and the log closed
+//          Does nothing if no log is attached
+void DnaDb::closeLog(){
+    if(m_logFd != -1){
+        flushLog();
+        close(m_logFd);
+        m_logFd = -1;
+    }
+    delete[] m_dirty;
+    m_dirty = nullptr;
+}
+
 // Name:    insert
 // Desc:    Inserts a dna into the DnaDb
 // Precon:  dna must not be within the DnaDb else doesn't insert it and returns false
 // Postcon: dna will be inserted at the proper location and returns true
 //          m_oldTable will be rehashed if there is an ongoing rehash or if the load factor is greater than .5
+//          If a log is attached the insertion is logged, and returns false if its record could
+//          not be written, the insertion still happens and the record stays buffered for a retry
 bool DnaDb::insert(DNA dna){
     bool output;
     if(dna == EMPTY || dna == DELETED){
@@ -48,6 +133,9 @@ bool DnaDb::insert(DNA dna){
     }else if(lambda() > .5f){
         rehashStart();
     }
+    if(output && m_logFd != -1){
+        output = logRecord('I', dna);
+    }
     return output;
 }
 
@@ -68,6 +156,7 @@ bool DnaDb::insertWithoutRehash(DNA& dna){
         m_currentSize++;
     }
     m_currentTable[hash] = dna;
+    markDirty(hash);
     return true;
 }
 
@@ -93,6 +182,8 @@ bool DnaDb::notInOld(DNA& dna){
 // Postcon: dna will be from the DnaDb and returns true
 //          m_oldTable will be rehashed if there is an ongoing rehash
 //          or if the ratio of deleted DNA to non-empty DNA is greater than .8
+//          If a log is attached the removal is logged, and returns false if its record could
+//          not be written, the removal still happens and the record stays buffered for a retry
 bool DnaDb::remove(DNA dna){
     bool output;
     if(dna == EMPTY || dna == DELETED){
@@ -105,6 +196,9 @@ bool DnaDb::remove(DNA dna){
     }else if(deletedRatio() > .8f){
         rehashStart();
     }
+    if(output && m_logFd != -1){
+        output = logRecord('R', dna);
+    }
     return output;
 }
 
@@ -121,6 +215,7 @@ bool DnaDb::removeFromCurrent(DNA& dna){
     }
     m_currNumDeleted++;
     m_currentTable[hash] = DELETED;
+    markDirty(hash);
     return true;
 }
 
@@ -175,9 +270,608 @@ void DnaDb::rehashStart(){
     m_currentCap = findNextPrime((m_currentSize - m_currNumDeleted) * 4);
     m_oldNumDeleted = m_currentSize = m_currNumDeleted = 0;
     m_currentTable = new DNA[m_currentCap];
+    resetDirty();
     rehash25();
 }
 
+// Name:    finishRehash
+// Desc:    Completes any ongoing rehash of m_oldTable to m_currentTable
+// Precon:  None
+// Postcon: All remaining DNA in m_oldTable will be in m_currentTable
+//          m_oldTable will be deleted and set to nullptr
+void DnaDb::finishRehash(){
+    if(m_oldTable != nullptr){
+        for(; m_oldNumDeleted < m_oldCap; m_oldNumDeleted++){
+            if(!(m_oldTable[m_oldNumDeleted] == EMPTY || m_oldTable[m_oldNumDeleted] == DELETED)){
+                insertWithoutRehash(m_oldTable[m_oldNumDeleted]);
+            }
+        }
+        delete[] m_oldTable;
+        m_oldTable = nullptr;
+    }
+}
+
+// Name:    placeNew
+// Desc:    Places a dna into m_currentTable without checking for duplicates
+// Precon:  dna must not be within m_currentTable and m_currentTable must have no deleted DNA
+// Postcon: dna will be placed in the first empty bucket of its probe sequence
+void DnaDb::placeNew(DNA& dna){
+    int hash = m_hash(dna.m_sequence) % m_currentCap;
+    for(int i = 0; !(m_currentTable[hash] == EMPTY); hash = (hash + ++i * i) % m_currentCap){}
+    m_currentTable[hash] = dna;
+    m_currentSize++;
+}
+
+// Name:    reserve
+// Desc:    Sizes m_currentTable so that n DNA fit without triggering a rehash
+// Precon:  n must be at most MAXPRIME / 2, the most DNA a table of MAXPRIME buckets
+//          holds below a load factor of .5, else does nothing and returns false
+// Postcon: Any ongoing rehash will be finished
+//          If m_currentTable is too small, or too full of deleted DNA for n DNA to stay
+//          below a load factor of .5, it is replaced once by a table of the first
+//          prime >= 2n within [MINPRIME,MAXPRIME], dropping deleted DNA
+//          If a log is attached and the table was rearranged, a checkpoint is written
+//          so recovery starts from the new layout
+//          Returns false if that checkpoint could not be written
+bool DnaDb::reserve(int n){
+    if(n > MAXPRIME / 2){
+        return false;
+    }
+    bool rehashing = m_oldTable != nullptr;
+    finishRehash();
+    if((resize(n) || rehashing) && m_logFd != -1){
+        return checkpoint();
+    }
+    return true;
+}
+
+// Name:    resize
+// Desc:    Replaces m_currentTable by one that fits n DNA below a load factor of .5
+// Precon:  There is no ongoing rehash
+// Postcon: If m_currentTable is too small, or its deleted DNA count toward the load factor
+//          enough that n DNA would pass .5, it is replaced by a table of the larger of its
+//          capacity and the first prime >= 2n within [MINPRIME,MAXPRIME], dropping deleted DNA,
+//          and returns true
+//          Otherwise does nothing and returns false
+bool DnaDb::resize(int n){
+    unsigned int newCap = findNextPrime(2 * n - 1);
+    if(newCap > m_currentCap || (m_currNumDeleted > 0 && 2 * (n + m_currNumDeleted) > m_currentCap)){
+        newCap = newCap > m_currentCap ? newCap : m_currentCap;
+        DNA* table = m_currentTable;
+        unsigned int cap = m_currentCap;
+        m_currentCap = newCap;
+        m_currentSize = m_currNumDeleted = 0;
+        m_currentTable = new DNA[m_currentCap];
+        resetDirty();
+        for(int i = 0; i < cap; i++){
+            if(!(table[i] == EMPTY || table[i] == DELETED)){
+                placeNew(table[i]);
+            }
+        }
+        delete[] table;
+        return true;
+    }
+    return false;
+}
+
+// Name:    build
+// Desc:    Bulk inserts size DNA from arr into the DnaDb
+// Precon:  The DNA already in the DnaDb plus size must be at most MAXPRIME / 2, else
+//          nothing is inserted and returns -1, duplicates in arr count toward the limit
+// Postcon: Any ongoing rehash will be finished, then the table is reserved once for the
+//          existing and new DNA and each DNA that is not EMPTY, DELETED or already present
+//          is inserted directly, without a rehash
+//          If a log is attached the placed DNA are not logged one by one, a checkpoint of
+//          the whole build is written instead
+//          Returns the number of DNA inserted, or -1 if that checkpoint could not be written,
+//          the DNA stay inserted and the next flushLog or checkpoint retries it
+int DnaDb::build(DNA arr[], int size){
+    int count = 0;
+    finishRehash();
+    if(size > MAXPRIME / 2 - (int) (m_currentSize - m_currNumDeleted)){
+        return -1;
+    }
+    resize(m_currentSize - m_currNumDeleted + size);
+    for(int i = 0; i < size; i++){
+        if(!(arr[i] == EMPTY || arr[i] == DELETED) && insertWithoutRehash(arr[i])){
+            count++;
+        }
+    }
+    if(m_logFd != -1){
+        m_ckptDue = m_ckptDue || count > 0;
+        if(!checkpoint()){
+            return -1;
+        }
+    }
+    return count;
+}
+
+// Name:    openLog
+// Desc:    Attaches a mutation log to the DnaDb, recovering any state already logged at path
+// Precon:  No log is attached, else does nothing and returns false
+//          A checkpoint found at path replaces the contents of the DnaDb
+// Postcon: The last committed checkpoint in path.ckpt is loaded bucket for bucket, then every
+//          complete record of path.log written since that checkpoint is replayed
+//          If path has no checkpoint and the DnaDb holds DNA, a full checkpoint is written so
+//          the DNA inserted before the log was attached are recovered too
+//          Records after the last commit in path.ckpt, and the log from its first torn record or
+//          record failing its checksum, are truncated
+//          Successful inserts and removes are then appended to path.log in groups of groupSize
+//          records with one fsync per group, and every ckptInterval of them (0 for never)
+//          a checkpoint is taken
+//          Returns false if the files could not be read or written, a missing file counts as empty
+bool DnaDb::openLog(string path, int groupSize, int ckptInterval){
+    if(m_logFd != -1){
+        return false;
+    }
+    string data;
+    // DNA inserted before the log was attached are in neither file
+    bool unlogged = m_currentSize > 0 || m_oldTable != nullptr;
+    m_logPath = path;
+    m_logGroup = groupSize < 1 ? 1 : groupSize;
+    m_ckptInterval = ckptInterval;
+    m_ckptGen = 0;
+    m_fullCkpt = true;
+    if(readFile(path + ".ckpt", data)){
+        int committed = replayCheckpoint(data);
+        if(committed == -1 || (committed < data.size() && !truncateFile(path + ".ckpt", committed))){
+            return false;
+        }
+        unlogged = false;
+        m_fullCkpt = committed == 0;
+        m_ckptSize = committed;
+        m_ckptFullSize = fullImageSize();
+    }else if(errno != ENOENT){
+        // any other error must not be mistaken for a fresh start, which would empty the log
+        return false;
+    }
+    delete[] m_dirty;
+    m_dirty = new bool[(m_currentCap + CKPTREGION - 1) / CKPTREGION]();
+    int valid = 0;
+    unsigned int gen;
+    int pos = 0;
+    if(readFile(path + ".log", data)){
+        if(unpackInt(data, pos, gen) && gen == m_ckptGen){
+            valid = replayLog(data);
+        }
+    }else if(errno != ENOENT){
+        return false;
+    }
+    int fd = open((path + ".log").c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if(fd == -1){
+        return false;
+    }
+    bool ok;
+    if(valid == 0){
+        string header;
+        packInt(header, m_ckptGen);
+        ok = ftruncate(fd, 0) == 0 && writeAll(fd, header);
+    }else{
+        ok = ftruncate(fd, valid) == 0;
+    }
+    if(!ok || fsync(fd) != 0){
+        close(fd);
+        return false;
+    }
+    m_logFd = fd;
+    m_logGen = m_ckptGen;
+    m_logSize = valid == 0 ? sizeof(m_ckptGen) : valid;
+    m_logBuffer = "";
+    m_logPending = m_sinceCkpt = 0;
+    if(unlogged && !checkpoint()){
+        closeLog();
+        return false;
+    }
+    return true;
+}
+
+// Name:    logRecord
+// Desc:    Appends a mutation record to the log buffer
+// Precon:  A log is attached, op is 'I' for insert or 'R' for remove
+// Postcon: The record, followed by the CRC32C of its bytes, is buffered, the buffer is
+//          written and fsynced once it holds m_logGroup records, and a checkpoint is taken
+//          every m_ckptInterval records
+//          Returns false if a write was due and the record is still only buffered
+bool DnaDb::logRecord(char op, DNA& dna){
+    int start = m_logBuffer.size();
+    bool ok = true;
+    m_logBuffer += op;
+    packDNA(m_logBuffer, dna);
+    packInt(m_logBuffer, crc32cHash(m_logBuffer.substr(start)));
+    if(++m_logPending >= m_logGroup){
+        ok = flushLog();
+    }
+    if(m_ckptInterval > 0 && ++m_sinceCkpt >= m_ckptInterval){
+        ok = checkpoint() && ok;
+    }
+    // a checkpoint that failed after writing the log still leaves the record durable
+    return ok || m_logPending == 0;
+}
+
+// Name:    flushLog
+// Desc:    Group commits the buffered log records
+// Precon:  A log is attached, else does nothing and returns false
+// Postcon: Buffered records are written to the log with a single fsync
+//          If a build's checkpoint failed, a checkpoint is taken instead since the log
+//          alone cannot recover the built DNA
+//          Returns false if the write failed, leaving the records buffered and the log
+//          truncated back to its last complete group so a retry appends right after it
+bool DnaDb::flushLog(){
+    if(m_logFd == -1){
+        return false;
+    }
+    return m_ckptDue ? checkpoint() : writeLog();
+}
+
+// Name:    writeLog
+// Desc:    Writes the buffered log records
+// Precon:  A log is attached
+// Postcon: If the log still has an older generation than the last checkpoint it is reset first
+//          Buffered records are then written to the log with a single fsync
+//          Returns false if the write failed, leaving the records buffered and the log
+//          truncated back to its last complete group
+bool DnaDb::writeLog(){
+    if(m_logGen != m_ckptGen && !resetLog()){
+        return false;
+    }
+    if(m_logPending > 0){
+        // a truncate that failed after an earlier write must succeed before appending again
+        if(lseek(m_logFd, 0, SEEK_END) != m_logSize && ftruncate(m_logFd, m_logSize) != 0){
+            return false;
+        }
+        if(!writeAll(m_logFd, m_logBuffer) || fsync(m_logFd) != 0){
+            ftruncate(m_logFd, m_logSize);
+            return false;
+        }
+        m_logSize += m_logBuffer.size();
+        m_logBuffer = "";
+        m_logPending = 0;
+    }
+    return true;
+}
+
+// Name:    resetLog
+// Desc:    Empties the log after a checkpoint
+// Precon:  A log is attached and the checkpoint of generation m_ckptGen is committed
+// Postcon: The log holds only the header of generation m_ckptGen
+//          Returns false if the log could not be written, it then keeps its old generation
+bool DnaDb::resetLog(){
+    string header;
+    packInt(header, m_ckptGen);
+    if(ftruncate(m_logFd, 0) != 0 || !writeAll(m_logFd, header) || fsync(m_logFd) != 0){
+        return false;
+    }
+    m_logGen = m_ckptGen;
+    m_logSize = header.size();
+    return true;
+}
+
+// Name:    checkpoint
+// Desc:    Writes an incremental checkpoint of the DnaDb
+// Precon:  A log is attached, else does nothing and returns false
+// Postcon: The buffered log records are written and any ongoing rehash is finished
+//          The regions of m_currentTable changed since the last checkpoint are appended to
+//          path.ckpt followed by a commit record
+//          After a resize, or once the appended records would outgrow the last full image,
+//          every region is written to a fresh file that replaces path.ckpt instead
+//          The log is then reset to start after the new checkpoint, if that fails the log keeps
+//          its old generation and the next write retries the reset before appending
+//          Returns false if the files could not be written
+bool DnaDb::checkpoint(){
+    if(m_logFd == -1 || !writeLog()){
+        return false;
+    }
+    finishRehash();
+    int regions = (m_currentCap + CKPTREGION - 1) / CKPTREGION;
+    bool full = m_fullCkpt;
+    string records;
+    for(int r = 0; r < regions; r++){
+        if(full || m_dirty[r]){
+            writeRegion(records, r);
+        }
+    }
+    // compact so that startup never replays more than about two full images
+    if(!full && m_ckptSize - m_ckptFullSize + records.size() > m_ckptFullSize){
+        full = true;
+        records = "";
+        for(int r = 0; r < regions; r++){
+            writeRegion(records, r);
+        }
+    }
+    records += 'C';
+    packInt(records, m_ckptGen + 1);
+    string ckptPath = m_logPath + ".ckpt";
+    bool ok;
+    if(full){
+        string tmpPath = ckptPath + ".tmp", header = "DNACKPT1";
+        packInt(header, m_currentCap);
+        int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ok = fd != -1 && writeAll(fd, header + records) && fsync(fd) == 0;
+        if(fd != -1){
+            close(fd);
+        }
+        ok = ok && rename(tmpPath.c_str(), ckptPath.c_str()) == 0 && syncDir(ckptPath);
+        if(ok){
+            m_ckptSize = m_ckptFullSize = header.size() + records.size();
+        }
+    }else{
+        int fd = open(ckptPath.c_str(), O_WRONLY | O_APPEND);
+        off_t before = fd == -1 ? -1 : lseek(fd, 0, SEEK_END);
+        ok = before != -1 && writeAll(fd, records) && fsync(fd) == 0;
+        if(ok){
+            m_ckptSize += records.size();
+        }else if(before != -1){
+            // drop the partial records so the next checkpoint appends after the last commit
+            ftruncate(fd, before);
+        }
+        if(fd != -1){
+            close(fd);
+        }
+    }
+    if(!ok){
+        return false;
+    }
+    // every logged record is now covered, a log from an older generation is ignored on recovery
+    m_ckptGen++;
+    for(int r = 0; r < regions; r++){
+        m_dirty[r] = false;
+    }
+    m_fullCkpt = m_ckptDue = false;
+    m_sinceCkpt = 0;
+    return resetLog();
+}
+
+// Name:    markDirty
+// Desc:    Marks the checkpoint region holding bucket hash of m_currentTable as changed
+// Precon:  None
+// Postcon: Does nothing if no log is attached
+void DnaDb::markDirty(int hash){
+    if(m_dirty != nullptr){
+        m_dirty[hash / CKPTREGION] = true;
+    }
+}
+
+// Name:    resetDirty
+// Desc:    Resizes the dirty regions after m_currentTable is replaced
+// Precon:  None
+// Postcon: Does nothing if no log is attached, else the next checkpoint will write every region
+void DnaDb::resetDirty(){
+    if(m_dirty != nullptr){
+        delete[] m_dirty;
+        m_dirty = new bool[(m_currentCap + CKPTREGION - 1) / CKPTREGION]();
+        m_fullCkpt = true;
+    }
+}
+
+// Name:    writeRegion
+// Desc:    Appends a checkpoint record of a region of m_currentTable to out
+// Precon:  region is within m_currentTable
+// Postcon: out holds 'G', the region index and every bucket of the region
+void DnaDb::writeRegion(string& out, int region){
+    out += 'G';
+    packInt(out, region);
+    for(int i = region * CKPTREGION; i < (region + 1) * CKPTREGION && i < m_currentCap; i++){
+        packDNA(out, m_currentTable[i]);
+    }
+}
+
+// Name:    fullImageSize
+// Desc:    Finds the size of a checkpoint file holding every region of m_currentTable
+// Precon:  None
+// Postcon: Returns the bytes of the header, every region record and a commit record
+int DnaDb::fullImageSize() const{
+    int regions = (m_currentCap + CKPTREGION - 1) / CKPTREGION;
+    int size = 12 + 5 + regions * 5;
+    for(int i = 0; i < m_currentCap; i++){
+        size += 8 + m_currentTable[i].m_sequence.length();
+    }
+    return size;
+}
+
+// Name:    replayCheckpoint
+// Desc:    Loads the contents of a checkpoint file into the DnaDb
+// Precon:  data is the contents of a checkpoint file
+// Postcon: m_currentTable is replaced by a table of the checkpointed size holding every region
+//          record up to the last commit record, records after it are ignored
+//          m_ckptGen is set to the last commit's generation
+//          Returns the length of data up to the last commit record, 0 if there is none,
+//          or -1 if data is not a checkpoint
+int DnaDb::replayCheckpoint(const string& data){
+    int pos = 8, committed = 0;
+    unsigned int cap, value;
+    if(data.compare(0, 8, "DNACKPT1") != 0 || !unpackInt(data, pos, cap) || cap == 0){
+        return -1;
+    }
+    int start = pos;
+    DNA dna;
+    while(pos < data.size()){
+        char type = data[pos++];
+        if(type == 'C' && unpackInt(data, pos, value)){
+            committed = pos;
+            m_ckptGen = value;
+        }else if(type == 'G' && unpackInt(data, pos, value) && value * CKPTREGION < cap){
+            bool complete = true;
+            for(int i = value * CKPTREGION; complete && i < (value + 1) * CKPTREGION && i < cap; i++){
+                complete = unpackDNA(data, pos, dna);
+            }
+            if(!complete){
+                break;
+            }
+        }else{
+            break;
+        }
+    }
+    delete[] m_currentTable;
+    delete[] m_oldTable;
+    m_oldTable = nullptr;
+    m_currentCap = cap;
+    m_currentTable = new DNA[m_currentCap];
+    for(pos = start; pos < committed;){
+        if(data[pos++] == 'G'){
+            unpackInt(data, pos, value);
+            for(int i = value * CKPTREGION; i < (value + 1) * CKPTREGION && i < cap; i++){
+                unpackDNA(data, pos, m_currentTable[i]);
+            }
+        }else{
+            unpackInt(data, pos, value);
+        }
+    }
+    m_currentSize = m_currNumDeleted = 0;
+    for(int i = 0; i < m_currentCap; i++){
+        if(m_currentTable[i] == DELETED){
+            m_currNumDeleted++;
+        }
+        if(!(m_currentTable[i] == EMPTY)){
+            m_currentSize++;
+        }
+    }
+    return committed;
+}
+
+// Name:    replayLog
+// Desc:    Replays the records of a log file
+// Precon:  data is the contents of a log file and no log is attached
+// Postcon: Every complete record after the generation header is applied in order,
+//          stopping at the first record that is torn or fails its checksum
+//          Returns the length of the valid prefix of data
+int DnaDb::replayLog(const string& data){
+    int pos = 4, next;
+    unsigned int checksum;
+    DNA dna;
+    while(pos < data.size()){
+        next = pos + 1;
+        if(!unpackDNA(data, next, dna)){
+            break;
+        }
+        string record = data.substr(pos, next - pos);
+        if(!unpackInt(data, next, checksum) || checksum != crc32cHash(record)){
+            break;
+        }
+        if(record[0] == 'I'){
+            insert(dna);
+        }else if(record[0] == 'R'){
+            remove(dna);
+        }else{
+            break;
+        }
+        pos = next;
+    }
+    return pos;
+}
+
+// Name:    packInt
+// Desc:    Appends value to out as 4 bytes in host byte order
+// Precon:  None
+// Postcon: out is 4 bytes longer
+void DnaDb::packInt(string& out, unsigned int value){
+    out.append((const char*) &value, sizeof(value));
+}
+
+// Name:    unpackInt
+// Desc:    Reads 4 bytes at pos of in as an unsigned int
+// Precon:  None
+// Postcon: Returns false if in is too short, else sets value and advances pos
+bool DnaDb::unpackInt(const string& in, int& pos, unsigned int& value){
+    if(pos + sizeof(value) > in.size()){
+        return false;
+    }
+    in.copy((char*) &value, sizeof(value), pos);
+    pos += sizeof(value);
+    return true;
+}
+
+// Name:    packDNA
+// Desc:    Appends dna to out as its location, its sequence length and its sequence
+// Precon:  None
+// Postcon: out holds the packed dna
+void DnaDb::packDNA(string& out, const DNA& dna){
+    packInt(out, dna.m_location);
+    packInt(out, dna.m_sequence.length());
+    out += dna.m_sequence;
+}
+
+// Name:    unpackDNA
+// Desc:    Reads a DNA packed by packDNA at pos of in
+// Precon:  None
+// Postcon: Returns false if in is too short, else sets dna and advances pos
+bool DnaDb::unpackDNA(const string& in, int& pos, DNA& dna){
+    unsigned int location, length;
+    int next = pos;
+    if(!unpackInt(in, next, location) || !unpackInt(in, next, length) || length > in.size() - next){
+        return false;
+    }
+    dna.m_location = location;
+    dna.m_sequence = in.substr(next, length);
+    pos = next + length;
+    return true;
+}
+
+// Name:    readFile
+// Desc:    Reads the whole file at path into data
+// Precon:  None
+// Postcon: Returns false if the file could not be opened or read, with errno telling why
+bool DnaDb::readFile(string path, string& data){
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd == -1){
+        return false;
+    }
+    char buffer[65536];
+    ssize_t count;
+    data = "";
+    while((count = read(fd, buffer, sizeof(buffer))) > 0){
+        data.append(buffer, count);
+    }
+    int error = errno;
+    close(fd);
+    errno = error;
+    return count == 0;
+}
+
+// Name:    truncateFile
+// Desc:    Truncates the file at path to size bytes
+// Precon:  None
+// Postcon: Returns false if the file could not be truncated and fsynced
+bool DnaDb::truncateFile(string path, int size){
+    int fd = open(path.c_str(), O_WRONLY);
+    if(fd == -1){
+        return false;
+    }
+    bool ok = ftruncate(fd, size) == 0 && fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// Name:    writeAll
+// Desc:    Writes all of data to fd
+// Precon:  None
+// Postcon: Returns false if a write failed
+bool DnaDb::writeAll(int fd, const string& data){
+    for(size_t done = 0; done < data.size();){
+        ssize_t count = write(fd, data.data() + done, data.size() - done);
+        if(count < 0){
+            return false;
+        }
+        done += count;
+    }
+    return true;
+}
+
+// Name:    syncDir
+// Desc:    Fsyncs the directory holding path so a rename into it is durable
+// Precon:  None
+// Postcon: Returns false if the directory could not be synced
+bool DnaDb::syncDir(string path){
+    size_t slash = path.rfind('/');
+    string dir = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = open(dir.c_str(), O_RDONLY);
+    if(fd == -1){
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
 // Name:    getDNA
 // Desc:    Finds a DNA within the DnaDb
 // Precon:  DNA must be within the DnaDb else returns EMPTY
@@ -191,9 +885,23 @@ DNA DnaDb::getDNA(string sequence, int location){
             }
         }
     }
+    int probes;
+    return m_currentTable[findInCurrent(sequence, location, probes)];
+}
+
+// Name:    findInCurrent
+// Desc:    Finds the bucket of m_currentTable where getDNA stops looking for a DNA
+// Precon:  None
+// Postcon: Returns the bucket holding the DNA with the m_sequence sequence and m_location location,
+//          or the empty bucket that ends its probe sequence
+//          probes holds the number of buckets visited
+int DnaDb::findInCurrent(string sequence, int location, int& probes) const{
     int hash = m_hash(sequence) % m_currentCap;
-    for(int i = 0; !(m_currentTable[hash] == EMPTY || m_currentTable[hash] == DNA(sequence, location)); hash = (hash + ++i * i) % m_currentCap){}
-    return m_currentTable[hash];
+    probes = 1;
+    for(int i = 0; !(m_currentTable[hash] == EMPTY || m_currentTable[hash] == DNA(sequence, location)); hash = (hash + ++i * i) % m_currentCap){
+        probes++;
+    }
+    return hash;
 }
 
 // Name:    lambda
@@ -9,10 +9,14 @@ class Grader;   // forward declaration, will be used for grdaing
 class Tester;   // forward declaration, will be used for testing
 class DNA;      // forward declaration
 class DnaDb;    // forward declaration
+class ShardedDnaDb; // forward declaration
+class Analyzer; // forward declaration, used by the hash analyzer
 const int MINLOCID = 1000;
 const int MAXLOCID = 9999;
 const int MINPRIME = 101;   // Min size for hash table
 const int MAXPRIME = 99991; // Max size for hash table
+const int CKPTREGION = 64;  // Buckets per checkpoint region
+const int LOGGROUP = 64;    // Default number of log records per group commit
 #define EMPTY DNA("")
 #define DELETED DNA("DELETED")
 #define DELETEDKEY "DELETED"
@@ -25,6 +29,7 @@ class DNA{
     friend class Grader;
     friend class Tester;
     friend class DnaDb;
+    friend class Analyzer;
     DNA(string sequence="", int location=0); // Constructor
     string getSequence() const;              // Returns the key
     int getLocId() const;
@@ -43,8 +48,14 @@ class DnaDb{
     public:
     friend class Grader;
     friend class Tester;
+    friend class ShardedDnaDb;
+    friend class Analyzer;
     DnaDb(int size, hash_fn hash);
+    // copies the tables, the copy has no log attached
+    DnaDb(const DnaDb& rhs);
     ~DnaDb();
+    // Overloaded assignment operator, detaches this from its log
+    const DnaDb& operator=(const DnaDb& rhs);
     // Returns Load factor of the new table
     float lambda() const;
     // Returns the ratio of deleted slots in the new table
@@ -55,6 +66,18 @@ class DnaDb{
     bool remove(DNA dna);
     // find can happen in either table
     DNA getDNA(string sequence, int location);
+    // sizes the table once so that n entries fit without a rehash,
+    // returns false if n is over MAXPRIME / 2 or its checkpoint failed
+    bool reserve(int n);
+    // bulk inserts size DNA, returns the number inserted,
+    // or -1 if the table could pass MAXPRIME / 2 entries or its checkpoint failed
+    int build(DNA arr[], int size);
+    // attaches a mutation log at path, recovering any state already logged there
+    bool openLog(string path, int groupSize = LOGGROUP, int ckptInterval = 0);
+    // writes and fsyncs the buffered log records
+    bool flushLog();
+    // writes the regions changed since the last checkpoint and resets the log
+    bool checkpoint();
     void dump() const;
 
     private:
@@ -72,6 +95,22 @@ class DnaDb{
                                     // m_oldSize includes deleted entries
     unsigned int    m_oldNumDeleted;// number of deleted entries
 
+    int             m_logFd;        // mutation log file descriptor, -1 if not logging
+    int             m_logSize;      // bytes of complete records in the log
+    string          m_logPath;      // path prefix of the log and checkpoint files
+    string          m_logBuffer;    // log records not yet written
+    int             m_logPending;   // number of records in m_logBuffer
+    int             m_logGroup;     // number of records per group commit
+    int             m_ckptInterval; // logged mutations between checkpoints, 0 if manual
+    int             m_sinceCkpt;    // logged mutations since the last checkpoint
+    unsigned int    m_ckptGen;      // generation of the last checkpoint
+    unsigned int    m_logGen;       // generation in the log's header, behind m_ckptGen until a reset succeeds
+    int             m_ckptSize;     // bytes in the checkpoint file
+    int             m_ckptFullSize; // bytes of the last full image in the checkpoint file
+    bool*           m_dirty;        // regions of m_currentTable changed since the last checkpoint
+    bool            m_fullCkpt;     // true if the next checkpoint must write every region
+    bool            m_ckptDue;      // true while built DNA are neither logged nor checkpointed
+
     //private helper functions
     bool isPrime(int number);
     static int findNextPrime(int current);
@@ -85,5 +124,28 @@ class DnaDb{
    bool removeFromOld(DNA& dna);
    void rehash25();
    void rehashStart();
+   void finishRehash();
+   int findInCurrent(string sequence, int location, int& probes) const;
+   void placeNew(DNA& dna);
+   bool resize(int n);
+   void copyFrom(const DnaDb& rhs);
+   void closeLog();
+   bool logRecord(char op, DNA& dna);
+   bool writeLog();
+   bool resetLog();
+   void markDirty(int hash);
+   void resetDirty();
+   void writeRegion(string& out, int region);
+   int fullImageSize() const;
+   int replayCheckpoint(const string& data);
+   int replayLog(const string& data);
+   static void packInt(string& out, unsigned int value);
+   static bool unpackInt(const string& in, int& pos, unsigned int& value);
+   static void packDNA(string& out, const DNA& dna);
+   static bool unpackDNA(const string& in, int& pos, DNA& dna);
+   static bool readFile(string path, string& data);
+   static bool truncateFile(string path, int size);
+   static bool writeAll(int fd, const string& data);
+   static bool syncDir(string path);
 };
 #endif
\ No newline at end of file
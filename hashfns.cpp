@@ -0,0 +1,185 @@
+/**
+ * File:    hashfns.cpp
+ * Project: CMSC 341 Project 4 – A DNA Database
+ *
+ * This file contains the built-in hash functions that can be passed to a DnaDb as its hash_fn
+ * DnaDb reduces every hash modulo a prime, so each of these mixes all of the key into
+ * all of the 32 bits it returns instead of leaving structure in the low bits
+ */
+#include "hashfns.h"
+#include <cstring>
+#include <stdint.h>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+const uint64_t GOLDEN = 0x9e3779b97f4a7c15ULL;  // 2^64 / golden ratio
+const uint64_t MIXER = 0xd6e8feb86659fd93ULL;   // odd multiplier for multiply-xorshift
+const uint32_t CASTAGNOLI = 0x82f63b78;         // reflected CRC32C polynomial
+const uint64_t WYSECRET[4] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+                              0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+
+// Name:    djbHash
+// Desc:    Hashes str with val = val * 33 + c
+// Precon:  None
+// Postcon: Returns the hash of str
+unsigned int djbHash(string str){
+    unsigned int val = 0;
+    for(unsigned int i = 0; i < str.length(); i++){
+        val = val * 33 + str[i];
+    }
+    return val;
+}
+
+// Name:    xorshiftMix
+// Desc:    Multiply-xorshift finalizer
+// Precon:  None
+// Postcon: Returns x with every input bit spread over every output bit
+static uint64_t xorshiftMix(uint64_t x){
+    x ^= x >> 32;
+    x *= MIXER;
+    x ^= x >> 29;
+    x *= MIXER;
+    x ^= x >> 32;
+    return x;
+}
+
+// Name:    packedHash
+// Desc:    Hashes str packed 2 bits per base
+// Precon:  str should be over A/C/G/T (either case), other characters share their low bits' code
+// Postcon: Returns the hash of str, each 64-bit word of 32 bases is folded in with xorshiftMix
+unsigned int packedHash(string str){
+    uint64_t hash = str.length() * GOLDEN, word = 0;
+    int bases = 0;
+    for(unsigned int i = 0; i < str.length(); i++){
+        // A=0, C=1, T=2, G=3
+        word = word << 2 | ((str[i] >> 1) & 3);
+        if(++bases == 32){
+            hash = xorshiftMix(hash ^ word);
+            word = bases = 0;
+        }
+    }
+    return xorshiftMix(hash ^ word);
+}
+
+// Name:    crc32cTable
+// Desc:    Builds the byte lookup table for crc32cSoftware
+// Precon:  None
+// Postcon: Returns the 256 entry table
+static const uint32_t* crc32cTable(){
+    static uint32_t table[256];
+    for(uint32_t i = 0; i < 256; i++){
+        uint32_t entry = i;
+        for(int bit = 0; bit < 8; bit++){
+            entry = entry & 1 ? (entry >> 1) ^ CASTAGNOLI : entry >> 1;
+        }
+        table[i] = entry;
+    }
+    return table;
+}
+
+// Name:    crc32cSoftware
+// Desc:    Table driven CRC32C
+// Precon:  None
+// Postcon: Returns crc updated with length bytes of data
+static uint32_t crc32cSoftware(uint32_t crc, const char* data, size_t length){
+    static const uint32_t* table = crc32cTable();
+    for(size_t i = 0; i < length; i++){
+        crc = table[(crc ^ (unsigned char) data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+// Name:    crc32cHardware
+// Desc:    CRC32C using the SSE4.2 crc32 instruction, 8 bytes at a time
+// Precon:  The CPU supports SSE4.2
+// Postcon: Returns crc updated with length bytes of data
+__attribute__((target("sse4.2")))
+static uint32_t crc32cHardware(uint32_t crc, const char* data, size_t length){
+    uint64_t crc64 = crc, chunk;
+    size_t i = 0;
+    for(; i + 8 <= length; i += 8){
+        memcpy(&chunk, data + i, 8);
+        crc64 = _mm_crc32_u64(crc64, chunk);
+    }
+    crc = crc64;
+    for(; i < length; i++){
+        crc = _mm_crc32_u8(crc, data[i]);
+    }
+    return crc;
+}
+#endif
+
+// Name:    crc32cHash
+// Desc:    Hashes str with CRC32C
+// Precon:  None
+// Postcon: Returns the standard CRC32C of str, computed in hardware when available
+unsigned int crc32cHash(string str){
+#if defined(__x86_64__)
+    static const bool hardware = __builtin_cpu_supports("sse4.2");
+    if(hardware){
+        return ~crc32cHardware(~0u, str.data(), str.length());
+    }
+#endif
+    return ~crc32cSoftware(~0u, str.data(), str.length());
+}
+
+// Name:    wyMix
+// Desc:    Multiplies a and b to 128 bits and folds the halves together
+// Precon:  None
+// Postcon: Returns the low half xor the high half of a * b
+static uint64_t wyMix(uint64_t a, uint64_t b){
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t) a * b;
+    return (uint64_t) product ^ (uint64_t) (product >> 64);
+#else
+    // 32-bit targets have no 128-bit integer, so build the product from 32-bit halves
+    uint64_t aLow = (uint32_t) a, aHigh = a >> 32, bLow = (uint32_t) b, bHigh = b >> 32;
+    uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh, highLow = aHigh * bLow;
+    uint64_t middle = (lowLow >> 32) + (uint32_t) lowHigh + (uint32_t) highLow;
+    uint64_t low = middle << 32 | (uint32_t) lowLow;
+    uint64_t high = aHigh * bHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+    return low ^ high;
+#endif
+}
+
+// Name:    wyRead
+// Desc:    Reads bytes (at most 8) of data as an integer in host byte order
+// Precon:  None
+// Postcon: Returns the value read
+static uint64_t wyRead(const char* data, int bytes){
+    uint64_t value = 0;
+    memcpy(&value, data, bytes);
+    return value;
+}
+
+// Name:    wyHash
+// Desc:    Hashes str in the style of wyhash
+// Precon:  None
+// Postcon: Returns the hash of str, 16 bytes are folded in per multiply
+unsigned int wyHash(string str){
+    const char* data = str.data();
+    size_t length = str.length();
+    uint64_t seed = wyMix(WYSECRET[0], WYSECRET[1]), a, b;
+    if(length <= 16){
+        if(length >= 4){
+            a = wyRead(data, 4) << 32 | wyRead(data + ((length >> 3) << 2), 4);
+            b = wyRead(data + length - 4, 4) << 32 | wyRead(data + length - 4 - ((length >> 3) << 2), 4);
+        }else if(length > 0){
+            a = (uint64_t) (unsigned char) data[0] << 16 | (uint64_t) (unsigned char) data[length >> 1] << 8
+                | (unsigned char) data[length - 1];
+            b = 0;
+        }else{
+            a = b = 0;
+        }
+    }else{
+        size_t i = length;
+        for(; i > 16; i -= 16, data += 16){
+            seed = wyMix(wyRead(data, 8) ^ WYSECRET[1], wyRead(data + 8, 8) ^ seed);
+        }
+        a = wyRead(data + i - 16, 8);
+        b = wyRead(data + i - 8, 8);
+    }
+    return wyMix(WYSECRET[1] ^ length, wyMix(a ^ WYSECRET[1], b ^ seed));
+}
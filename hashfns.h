@@ -0,0 +1,15 @@
+// Built-in hash functions for DnaDb
+#ifndef HASHFNS_H
+#define HASHFNS_H
+#include <string>
+using namespace std;
+
+// djb style hash, val * 33 + c, kept as a baseline
+unsigned int djbHash(string str);
+// packs A/C/G/T into 2 bits each, mixes 32 bases at a time with multiply-xorshift
+unsigned int packedHash(string str);
+// CRC32C (Castagnoli), SSE4.2 accelerated when the CPU supports it
+unsigned int crc32cHash(string str);
+// wyhash style 64-bit multiply-fold hash
+unsigned int wyHash(string str);
+#endif
@@ -1,6 +1,14 @@
 #include "dnadb.h"
+#include "shardeddnadb.h"
+#include "hashfns.h"
 #include <time.h>
+#include <stdio.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+const char LOGPATH[] = "mytest_wal";
 const char BREAK[] = "*****************************************************************\n";
 
 unsigned int hashCode(const string str){
@@ -30,6 +38,25 @@ class Tester{
         static bool insertRehashTest(DnaDb dnadb, DNA arr[]);
         static bool removeRehashTest(DnaDb dnadb, DNA arr[]);
         static bool getDNATest(DnaDb dnadb, DNA arr[], int size, bool answer);
+        static bool reserveTest(DnaDb dnadb, DNA arr[], int size, int n);
+        static bool buildTest(DnaDb dnadb, DNA arr[], int size, int answer);
+        static bool buildPastMaxTest(int unique, int repeats);
+        static bool shardInsertTest(ShardedDnaDb& sharded, DNA arr[], int size, int answer);
+        static bool shardRemoveTest(ShardedDnaDb& sharded, DNA arr[], int size, int answer);
+        static bool shardSpreadTest(ShardedDnaDb& sharded, DNA arr[], int size);
+        static bool shardSingleTest(ShardedDnaDb& sharded, DNA arr[], int size);
+        static bool recoverTest(DNA arr[], int size, bool checkpoints);
+        static bool tornLogTest(DNA arr[], int size, string tail);
+        static bool logRetryTest(DNA arr[], int size);
+        static bool failedBuildTest(DNA arr[], int size);
+        static bool openFilledTest(DNA arr[], int size);
+        static bool unreadableCheckpointTest(DNA arr[], int size);
+        static bool tornCheckpointTest(DNA arr[], int size);
+        static bool recoverBuildTest(DNA arr[], int size);
+        static bool compactionTest(DNA arr[], int size, int checkpoints);
+        static bool copyLogTest(DNA arr[], int size);
+        static long fileSize(string path);
+        static bool builtinHashTest(DNA arr[], int size);
         static bool hashInArray(DNA arr[], DNA dna, int size, hash_fn hash, int divisor);
         static bool inArray(DNA arr[], DNA dna, int size);
         static DnaDb copy(DnaDb& rhs);
@@ -136,6 +163,123 @@ int main(){
         test.result(Tester::getDNATest(Tester::copy(noCol), findDNA, numDNA, false));
     }
 
+    cout << BREAK << "Testing DnaDb::reserve(int) and DnaDb::build(DNA[], int)\n" << BREAK << endl;
+    {   cout << "Normal: Reserving room for more data";
+        test.result(Tester::reserveTest(Tester::copy(noCol), noColDNA, numDNA, tableSize));
+    }
+    {   cout << "Edge: Reserving room in a table full of deleted data";
+        const int reserveSize = 1009;
+        DnaDb dnadb(reserveSize, hashCode);
+        DNA reserveDNA[reserveSize * 2 / 5];
+        for(int i = 0; i < reserveSize * 2 / 5; i++){
+            do{
+                reserveDNA[i] = Tester::randDNA();
+            }while(Tester::inArray(reserveDNA, reserveDNA[i], i));
+            dnadb.insert(reserveDNA[i]);
+        }
+        for(int i = reserveSize / 10; i < reserveSize * 2 / 5; i++){
+            dnadb.remove(reserveDNA[i]);
+        }
+        test.result(Tester::reserveTest(Tester::copy(dnadb), reserveDNA, reserveSize / 10, reserveSize * 2 / 5));
+    }
+    {   cout << "Normal: Building from a dataset";
+        test.result(Tester::buildTest(DnaDb(MINPRIME, hashCode), noColDNA, numDNA, numDNA));
+    }
+    {   cout << "Edge: Building from a dataset with duplicate data";
+        DNA buildDNA[numDNA * 2];
+        for(int i = 0; i < numDNA; i++){
+            buildDNA[i] = buildDNA[i + numDNA] = colDNA[i];
+        }
+        test.result(Tester::buildTest(DnaDb(MINPRIME, hashCode), buildDNA, numDNA * 2, numDNA));
+    }
+    {   cout << "Error: Building past MAXPRIME / 2 DNA with duplicate data";
+        test.result(Tester::buildPastMaxTest(MAXPRIME / 2, 400));
+    }
+
+    cout << BREAK << "Testing ShardedDnaDb\n" << BREAK << endl;
+    {   cout << "Normal: Inserting a batch across shards";
+        ShardedDnaDb sharded(4, tableSize, hashCode);
+        test.result(Tester::shardInsertTest(sharded, noColDNA, numDNA, numDNA));
+    }
+    {   cout << "Normal: Removing a batch across shards";
+        ShardedDnaDb sharded(4, tableSize, hashCode);
+        sharded.insert(colDNA, numDNA);
+        test.result(Tester::shardRemoveTest(sharded, colDNA, numDNA, numDNA));
+    }
+    {   cout << "Normal: Inserting and removing one at a time across shard rehashes";
+        ShardedDnaDb sharded(4, MINPRIME * 4, hashCode);
+        DNA singleDNA[MINPRIME * 4];
+        for(int i = 0; i < MINPRIME * 4; i++){
+            do{
+                singleDNA[i] = Tester::randDNA();
+            }while(Tester::inArray(singleDNA, singleDNA[i], i));
+        }
+        test.result(Tester::shardSingleTest(sharded, singleDNA, MINPRIME * 4));
+    }
+    {   cout << "Edge: Spreading short keys across every shard";
+        ShardedDnaDb sharded(4, tableSize, hashCode);
+        DNA spreadDNA[numDNA];
+        for(int i = 0; i < numDNA; i++){
+            spreadDNA[i] = DNA(sequencer(5), rand() % (MAXLOCID - MINLOCID + 1) + MINLOCID);
+        }
+        test.result(Tester::shardSpreadTest(sharded, spreadDNA, numDNA));
+    }
+    {   cout << "Error: Inserting an already existing batch";
+        ShardedDnaDb sharded(4, tableSize, hashCode);
+        sharded.insert(noColDNA, numDNA);
+        test.result(Tester::shardInsertTest(sharded, noColDNA, numDNA, 0));
+    }
+
+    cout << BREAK << "Testing DnaDb::openLog(string, int, int) and DnaDb::checkpoint()\n" << BREAK << endl;
+    {   cout << "Normal: Recovering logged inserts and removes";
+        test.result(Tester::recoverTest(noColDNA, numDNA, false));
+    }
+    {   cout << "Normal: Recovering from incremental checkpoints";
+        test.result(Tester::recoverTest(colDNA, numDNA, true));
+    }
+    {   cout << "Normal: Recovering a bulk build";
+        test.result(Tester::recoverBuildTest(colDNA, numDNA));
+    }
+    {   cout << "Edge: Attaching a log to a DnaDb that already holds data";
+        test.result(Tester::openFilledTest(noColDNA, numDNA));
+    }
+    {   cout << "Error: Attaching a log whose checkpoint cannot be read";
+        test.result(Tester::unreadableCheckpointTest(noColDNA, numDNA));
+    }
+    {   cout << "Edge: Compacting after many incremental checkpoints";
+        test.result(Tester::compactionTest(noColDNA, numDNA, 200));
+    }
+    {   cout << "Edge: Copying a DnaDb with a log attached";
+        test.result(Tester::copyLogTest(noColDNA, numDNA));
+    }
+    {   cout << "Edge: Recovering from a log with a torn record";
+        test.result(Tester::tornLogTest(noColDNA, numDNA, string("I\x01\x02", 3)));
+    }
+    {   cout << "Edge: Recovering from a log with a record failing its checksum";
+        test.result(Tester::tornLogTest(noColDNA, numDNA, string("I\xe8\x03\0\0\x04\0\0\0ACGT\0\0\0\0", 17)));
+    }
+    {   cout << "Edge: Retrying a group commit after a failed write";
+        test.result(Tester::logRetryTest(noColDNA, 4));
+    }
+    {   cout << "Error: Inserting and building while the files cannot be written";
+        test.result(Tester::failedBuildTest(noColDNA, numDNA));
+    }
+    {   cout << "Edge: Checkpointing after a torn checkpoint record";
+        test.result(Tester::tornCheckpointTest(noColDNA, numDNA));
+    }
+
+    cout << BREAK << "Testing built-in hash functions\n" << BREAK << endl;
+    {   cout << "Normal: Finding data with every built-in hash";
+        test.result(Tester::builtinHashTest(colDNA, numDNA));
+    }
+    {   cout << "Normal: CRC32C of the standard check string";
+        test.result(crc32cHash("123456789") == 0xe3069283);
+    }
+    {   cout << "Edge: Packed hash of runs of the zero base";
+        test.result(packedHash("") != packedHash("A") && packedHash("A") != packedHash("AA")
+                && packedHash(string(32, 'A')) != packedHash(string(33, 'A')));
+    }
+
     cout << BREAK << "Number of tests: " << test.getTestCount()
          << "\nNumber of tests failed: " << test.getFailCount()
          << endl << BREAK;
@@ -287,6 +431,460 @@ bool Tester::getDNATest(DnaDb dnadb, DNA arr[], int size, bool answer){
     return true;
 }
 
+bool Tester::reserveTest(DnaDb dnadb, DNA arr[], int size, int n){
+    dnadb.reserve(n);
+    if(dnadb.m_oldTable != nullptr || dnadb.m_currNumDeleted != 0 || dnadb.m_currentCap < 2 * n){
+        return false;
+    }
+    for(int i = 0; i < size; i++){
+        if(dnadb.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY){
+            return false;
+        }
+    }
+    DNA* oldAddress = dnadb.m_currentTable;
+    while(dnadb.m_currentSize < n){
+        DNA dna;
+        do{
+            dna = randDNA();
+        }while(!(dnadb.getDNA(dna.m_sequence, dna.m_location) == EMPTY));
+        dnadb.insert(dna);
+        if(dnadb.m_currentTable != oldAddress){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Tester::buildTest(DnaDb dnadb, DNA arr[], int size, int answer){
+    if(dnadb.build(arr, size) != answer
+            || dnadb.m_oldTable != nullptr
+            || dnadb.m_currentSize != answer
+            || dnadb.lambda() > .5f){
+        return false;
+    }
+    return getDNATest(Tester::copy(dnadb), arr, size, true);
+}
+
+bool Tester::shardSpreadTest(ShardedDnaDb& sharded, DNA arr[], int size){
+    sharded.insert(arr, size);
+    for(int s = 0; s < sharded.m_numShards; s++){
+        if(sharded.m_shards[s]->m_currentSize == 0){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Tester::shardSingleTest(ShardedDnaDb& sharded, DNA arr[], int size){
+    for(int i = 0; i < size; i++){
+        if(!sharded.insert(arr[i]) || sharded.insert(arr[i])){
+            return false;
+        }
+    }
+    for(int i = 0; i < size; i++){
+        if(sharded.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY){
+            return false;
+        }
+    }
+    for(int i = 0; i < size; i++){
+        if(!sharded.remove(arr[i]) || sharded.remove(arr[i])){
+            return false;
+        }
+    }
+    for(int i = 0; i < size; i++){
+        if(!(sharded.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY)){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Tester::buildPastMaxTest(int unique, int repeats){
+    DNA* arr = new DNA[unique + repeats];
+    for(int i = 0; i < unique; i++){
+        string sequence = "";
+        for(int j = 0, n = i; j < 10; j++, n /= MAX){
+            sequence += ALPHA[n % MAX];
+        }
+        arr[i] = DNA(sequence, MINLOCID + i % (MAXLOCID - MINLOCID + 1));
+    }
+    for(int i = 0; i < repeats; i++){
+        arr[unique + i] = arr[rand() % unique];
+    }
+    DnaDb dnadb(MINPRIME, hashCode);
+    bool output = dnadb.build(arr, unique + repeats) == -1 && !dnadb.reserve(unique + repeats)
+            && dnadb.m_currentSize == 0 && dnadb.m_currentCap == MINPRIME;
+    output = output && dnadb.build(arr, unique) == unique && dnadb.m_oldTable == nullptr
+            && dnadb.m_currentSize == unique && dnadb.lambda() <= .5f;
+    delete[] arr;
+    return output;
+}
+
+bool Tester::shardInsertTest(ShardedDnaDb& sharded, DNA arr[], int size, int answer){
+    if(sharded.insert(arr, size) != answer){
+        return false;
+    }
+    unsigned int totalSize = 0, totalCap = 0;
+    for(int s = 0; s < sharded.m_numShards; s++){
+        totalSize += sharded.m_shards[s]->m_currentSize;
+        totalCap += sharded.m_shards[s]->m_currentCap;
+    }
+    if(sharded.lambda() != (float) totalSize / totalCap){
+        return false;
+    }
+    for(int i = 0; i < size; i++){
+        DnaDb* owner = sharded.m_shards[sharded.shardOf(arr[i].m_sequence)];
+        if(owner->getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY
+                || sharded.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Tester::shardRemoveTest(ShardedDnaDb& sharded, DNA arr[], int size, int answer){
+    if(sharded.remove(arr, size) != answer){
+        return false;
+    }
+    unsigned int totalDeleted = 0, totalSize = 0;
+    for(int s = 0; s < sharded.m_numShards; s++){
+        totalDeleted += sharded.m_shards[s]->m_currNumDeleted;
+        totalSize += sharded.m_shards[s]->m_currentSize;
+    }
+    // a fully removed table rehashes to empty and its ratio is 0 / 0
+    if(totalSize == 0 ? !isnan(sharded.deletedRatio()) : sharded.deletedRatio() != (float) totalDeleted / totalSize){
+        return false;
+    }
+    for(int i = 0; i < size; i++){
+        if(!(sharded.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY)){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Tester::recoverTest(DNA arr[], int size, bool checkpoints){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    DnaDb* dnadb = new DnaDb(MINPRIME, hashCode);
+    if(!dnadb->openLog(path, 8)){
+        delete dnadb;
+        return false;
+    }
+    for(int i = 0; i < size; i++){
+        dnadb->insert(arr[i]);
+    }
+    if(checkpoints){
+        long fullSize = fileSize(path + ".ckpt");
+        if(!dnadb->checkpoint() || fileSize(path + ".ckpt") <= fullSize || dnadb->m_fullCkpt){
+            delete dnadb;
+            return false;
+        }
+        fullSize = fileSize(path + ".ckpt");
+        dnadb->remove(arr[0]);
+        if(!dnadb->checkpoint() || fileSize(path + ".ckpt") - fullSize >= fullSize){
+            delete dnadb;
+            return false;
+        }
+    }
+    for(int i = 0; i < size / 2; i++){
+        dnadb->remove(arr[i]);
+    }
+    delete dnadb;
+    DnaDb recovered(MINPRIME, hashCode);
+    bool output = recovered.openLog(path, 8);
+    for(int i = 0; i < size && output; i++){
+        output = (recovered.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY) == (i < size / 2);
+    }
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    return output;
+}
+
+bool Tester::tornLogTest(DNA arr[], int size, string tail){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        dnadb.openLog(path, size + 1);
+        for(int i = 0; i < size; i++){
+            dnadb.insert(arr[i]);
+        }
+    }
+    long validSize = fileSize(path + ".log");
+    FILE* log = fopen((path + ".log").c_str(), "ab");
+    fwrite(tail.data(), 1, tail.size(), log);
+    fclose(log);
+    DnaDb recovered(MINPRIME, hashCode);
+    bool output = recovered.openLog(path) && fileSize(path + ".log") == validSize
+            && recovered.getDNA("ACGT", MINLOCID) == EMPTY;
+    for(int i = 0; i < size && output; i++){
+        output = !(recovered.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY);
+    }
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    return output;
+}
+
+bool Tester::openFilledTest(DNA arr[], int size){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    bool output;
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        for(int i = 0; i < size - 1; i++){
+            dnadb.insert(arr[i]);
+        }
+        output = dnadb.openLog(path) && dnadb.insert(arr[size - 1]);
+    }
+    DnaDb recovered(MINPRIME, hashCode);
+    output = output && recovered.openLog(path);
+    for(int i = 0; i < size && output; i++){
+        output = !(recovered.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY);
+    }
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    return output;
+}
+
+bool Tester::unreadableCheckpointTest(DNA arr[], int size){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        dnadb.openLog(path);
+        for(int i = 0; i < size; i++){
+            dnadb.insert(arr[i]);
+        }
+    }
+    // reading a directory fails with EISDIR rather than ENOENT
+    long logSize = fileSize(path + ".log");
+    mkdir((path + ".ckpt").c_str(), 0755);
+    bool output;
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        output = !dnadb.openLog(path) && fileSize(path + ".log") == logSize;
+    }
+    rmdir((path + ".ckpt").c_str());
+    DnaDb recovered(MINPRIME, hashCode);
+    output = output && recovered.openLog(path);
+    for(int i = 0; i < size && output; i++){
+        output = !(recovered.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY);
+    }
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    return output;
+}
+
+bool Tester::logRetryTest(DNA arr[], int size){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    bool output;
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        output = dnadb.openLog(path, size + 1);
+        for(int i = 0; i < size; i++){
+            dnadb.insert(arr[i]);
+        }
+        // let the group commit stop partway through its second record
+        struct rlimit original, limit;
+        void (*handler)(int) = signal(SIGXFSZ, SIG_IGN);
+        getrlimit(RLIMIT_FSIZE, &original);
+        limit = original;
+        limit.rlim_cur = fileSize(path + ".log") + 20;
+        setrlimit(RLIMIT_FSIZE, &limit);
+        output = output && !dnadb.flushLog() && fileSize(path + ".log") == 4;
+        setrlimit(RLIMIT_FSIZE, &original);
+        signal(SIGXFSZ, handler);
+        output = output && dnadb.flushLog();
+    }
+    DnaDb recovered(MINPRIME, hashCode);
+    output = output && recovered.openLog(path);
+    for(int i = 0; i < size && output; i++){
+        output = !(recovered.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY);
+    }
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    return output;
+}
+
+bool Tester::failedBuildTest(DNA arr[], int size){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    bool output;
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        output = dnadb.openLog(path, 1);
+        // only the log's header fits, so every record and checkpoint fails
+        struct rlimit original, limit;
+        void (*handler)(int) = signal(SIGXFSZ, SIG_IGN);
+        getrlimit(RLIMIT_FSIZE, &original);
+        limit = original;
+        limit.rlim_cur = fileSize(path + ".log");
+        setrlimit(RLIMIT_FSIZE, &limit);
+        output = output && !dnadb.insert(arr[0]) && !dnadb.flushLog() && dnadb.build(arr + 1, size - 1) == -1;
+        setrlimit(RLIMIT_FSIZE, &original);
+        signal(SIGXFSZ, handler);
+        output = output && !(dnadb.getDNA(arr[size - 1].m_sequence, arr[size - 1].m_location) == EMPTY)
+                && dnadb.flushLog() && fileSize(path + ".ckpt") > 0;
+    }
+    DnaDb recovered(MINPRIME, hashCode);
+    output = output && recovered.openLog(path);
+    for(int i = 0; i < size && output; i++){
+        output = !(recovered.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY);
+    }
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    std::remove((path + ".ckpt.tmp").c_str());
+    return output;
+}
+
+bool Tester::builtinHashTest(DNA arr[], int size){
+    hash_fn hashes[] = {djbHash, packedHash, crc32cHash, wyHash};
+    for(int i = 0; i < 4; i++){
+        if(!buildTest(DnaDb(MINPRIME, hashes[i]), arr, size, size)){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Tester::recoverBuildTest(DNA arr[], int size){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    bool output;
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        output = dnadb.openLog(path) && dnadb.build(arr, size) == size;
+    }
+    DnaDb recovered(MINPRIME, hashCode);
+    output = output && recovered.openLog(path);
+    for(int i = 0; i < size && output; i++){
+        output = !(recovered.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY);
+    }
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    return output;
+}
+
+bool Tester::compactionTest(DNA arr[], int size, int checkpoints){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    bool output, compacted = false;
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        output = dnadb.openLog(path);
+        for(int i = 0; i < size; i++){
+            dnadb.insert(arr[i]);
+        }
+        output = output && dnadb.checkpoint();
+        long fullSize = fileSize(path + ".ckpt"), lastSize = fullSize;
+        for(int i = 0; i < checkpoints && output; i++){
+            dnadb.remove(arr[i % size]);
+            dnadb.insert(arr[i % size]);
+            output = dnadb.checkpoint() && fileSize(path + ".ckpt") <= 2 * fullSize + fullSize / 10;
+            compacted = compacted || fileSize(path + ".ckpt") < lastSize;
+            lastSize = fileSize(path + ".ckpt");
+        }
+    }
+    DnaDb recovered(MINPRIME, hashCode);
+    output = output && compacted && recovered.openLog(path);
+    for(int i = 0; i < size && output; i++){
+        output = !(recovered.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY);
+    }
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    return output;
+}
+
+bool Tester::copyLogTest(DNA arr[], int size){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    bool output;
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        output = dnadb.openLog(path);
+        for(int i = 0; i < size / 2; i++){
+            dnadb.insert(arr[i]);
+        }
+        DnaDb copied(dnadb), assigned(MINPRIME, hashCode);
+        assigned = dnadb;
+        output = output && copied.m_logFd == -1 && copied.m_dirty == nullptr
+                && assigned.m_logFd == -1 && assigned.m_dirty == nullptr
+                && copied.m_currentTable != dnadb.m_currentTable;
+        for(int i = size / 2; i < size; i++){
+            copied.insert(arr[i]);
+            dnadb.insert(arr[i]);
+        }
+        output = output && getDNATest(Tester::copy(copied), arr, size, true)
+                && getDNATest(Tester::copy(assigned), arr, size / 2, true);
+    }
+    DnaDb recovered(MINPRIME, hashCode);
+    output = output && recovered.openLog(path) && getDNATest(Tester::copy(recovered), arr, size, true);
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    return output;
+}
+
+bool Tester::tornCheckpointTest(DNA arr[], int size){
+    string path = LOGPATH;
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        dnadb.openLog(path);
+        for(int i = 0; i < size / 3; i++){
+            dnadb.insert(arr[i]);
+        }
+        dnadb.checkpoint();
+        for(int i = size / 3; i < size * 2 / 3; i++){
+            dnadb.insert(arr[i]);
+        }
+        dnadb.checkpoint();
+    }
+    long validSize = fileSize(path + ".ckpt");
+    FILE* ckpt = fopen((path + ".ckpt").c_str(), "ab");
+    fwrite("G\x01\x00\x00\x00\xe8\x03", 1, 7, ckpt);
+    fclose(ckpt);
+    bool output;
+    {
+        DnaDb dnadb(MINPRIME, hashCode);
+        output = dnadb.openLog(path) && fileSize(path + ".ckpt") == validSize;
+        for(int i = size * 2 / 3; i < size; i++){
+            dnadb.insert(arr[i]);
+        }
+        output = output && dnadb.checkpoint();
+    }
+    DnaDb recovered(MINPRIME, hashCode);
+    output = output && recovered.openLog(path);
+    for(int i = 0; i < size && output; i++){
+        output = !(recovered.getDNA(arr[i].m_sequence, arr[i].m_location) == EMPTY);
+    }
+    std::remove((path + ".log").c_str());
+    std::remove((path + ".ckpt").c_str());
+    return output;
+}
+
+long Tester::fileSize(string path){
+    FILE* file = fopen(path.c_str(), "rb");
+    if(file == nullptr){
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
 bool Tester::hashInArray(DNA arr[], DNA dna, int size, hash_fn hash, int divisor){
     for(int i = 0; i < size; i++){
         if(hash(dna.m_sequence) % divisor == hash(arr[i].m_sequence) % divisor){
@@ -0,0 +1,349 @@
+/**
+ * File:    shardeddnadb.cpp
+ * Project: CMSC 341 Project 4 – A DNA Database
+ *
+ * This file contains the implementation of the ShardedDnaDb class
+ * A ShardedDnaDb partitions DNA by the high bits of their hash into independent DnaDb shards
+ * Each shard is allocated by a persistent ShardWorker thread bound to the CPUs of one NUMA node,
+ * and every operation that could allocate a table for it runs on that worker, so on a
+ * multi-socket machine its tables, including those allocated by later rehashes, are
+ * first-touched on that node
+ * Single operations that cannot allocate run on the calling thread, since a round trip
+ * through the worker costs more than the operation itself
+ */
+#include "shardeddnadb.h"
+#include <fstream>
+#include <cstdio>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Name:    ShardedDnaDb (Constructor)
+// Desc:    Constructor for ShardedDnaDb
+// Precon:  None
+// Postcon: numShards DnaDb will be created, clamped within [1,MAXSHARDS]
+//          Each shard starts with size / numShards buckets and is allocated by its own worker
+ShardedDnaDb::ShardedDnaDb(int numShards, int size, hash_fn hash) : m_hash(hash),
+        m_numShards(numShards < 1 ? 1 : numShards > MAXSHARDS ? MAXSHARDS : numShards){
+    m_shards = new DnaDb*[m_numShards];
+    m_workers = new ShardWorker*[m_numShards];
+    for(int s = 0; s < m_numShards; s++){
+        m_workers[s] = new ShardWorker(s, size / m_numShards, m_hash);
+        m_shards[s] = m_workers[s]->getDb();
+    }
+}
+
+// Name:    ~ShardedDnaDb (Destructor)
+// Desc:    Destructor for ShardedDnaDb
+// Precon:  None
+// Postcon: All shards will be deallocated and their workers stopped
+ShardedDnaDb::~ShardedDnaDb(){
+    for(int s = 0; s < m_numShards; s++){
+        delete m_workers[s];
+    }
+    delete[] m_workers;
+    delete[] m_shards;
+}
+
+// Name:    shardOf
+// Desc:    Finds the shard that owns sequence
+// Precon:  None
+// Postcon: Returns the shard index taken from the high bits of the hash of sequence
+//          after a multiply-xorshift finalizer, since hashes such as djb leave the high
+//          bits of short keys almost constant
+//          The shard's own modulo still uses the unmixed hash
+int ShardedDnaDb::shardOf(const string& sequence) const{
+    unsigned long long mixed = m_hash(sequence);
+    mixed ^= mixed >> 33;
+    mixed *= 0xff51afd7ed558ccdULL;
+    mixed ^= mixed >> 33;
+    mixed *= 0xc4ceb9fe1a85ec53ULL;
+    mixed ^= mixed >> 33;
+    return ((mixed >> 32) * m_numShards) >> 32;
+}
+
+// Name:    readList
+// Desc:    Reads a sysfs list such as 0-23,48-71 from path
+// Precon:  None
+// Postcon: Returns false if path could not be opened, else ids holds every listed number
+bool ShardedDnaDb::readList(string path, vector<int>& ids){
+    ifstream list(path);
+    string range;
+    if(!list){
+        return false;
+    }
+    while(getline(list, range, ',')){
+        int first, last;
+        int fields = sscanf(range.c_str(), "%d-%d", &first, &last);
+        if(fields == 1){
+            last = first;
+        }
+        for(int id = first; fields >= 1 && id <= last; id++){
+            ids.push_back(id);
+        }
+    }
+    return true;
+}
+
+// Name:    bindShard
+// Desc:    Binds the calling thread to the NUMA node serving shard
+// Precon:  None
+// Postcon: On Linux the thread will run on the allowed CPUs of the online node
+//          shard % number of nodes, read from /sys/devices/system/node,
+//          so memory it first touches is placed on that node
+//          Does nothing elsewhere, if no nodes are listed or if none of the node's CPUs are allowed
+void ShardedDnaDb::bindShard(int shard){
+#ifdef __linux__
+    const string NODES = "/sys/devices/system/node/";
+    vector<int> nodes, cpus;
+    cpu_set_t allowed, bound;
+    if(!readList(NODES + "online", nodes) || nodes.empty()
+            || !readList(NODES + "node" + to_string(nodes[shard % nodes.size()]) + "/cpulist", cpus)
+            || sched_getaffinity(0, sizeof(allowed), &allowed) != 0){
+        return;
+    }
+    CPU_ZERO(&bound);
+    for(int i = 0; i < cpus.size(); i++){
+        if(cpus[i] < CPU_SETSIZE && CPU_ISSET(cpus[i], &allowed)){
+            CPU_SET(cpus[i], &bound);
+        }
+    }
+    if(CPU_COUNT(&bound) > 0){
+        pthread_setaffinity_np(pthread_self(), sizeof(bound), &bound);
+    }
+#endif
+}
+
+// Name:    insert
+// Desc:    Inserts a dna into the shard that owns it
+// Precon:  dna must not be within the ShardedDnaDb else doesn't insert it and returns false
+// Postcon: dna will be inserted into its shard, on the calling thread unless the insert
+//          could start a rehash, then by the shard's worker so the new table is placed on its node
+bool ShardedDnaDb::insert(DNA dna){
+    int s = shardOf(dna.getSequence());
+    bool output;
+    if(onCaller(s, true)){
+        return m_shards[s]->insert(dna);
+    }
+    m_workers[s]->run([&](){ output = m_shards[s]->insert(dna); });
+    return output;
+}
+
+// Name:    remove
+// Desc:    Removes a dna from the shard that owns it
+// Precon:  dna must be within the ShardedDnaDb else doesn't remove it and returns false
+// Postcon: dna will be removed from its shard, on the calling thread unless the removal
+//          could start a rehash, then by the shard's worker so the new table is placed on its node
+bool ShardedDnaDb::remove(DNA dna){
+    int s = shardOf(dna.getSequence());
+    bool output;
+    if(onCaller(s, false)){
+        return m_shards[s]->remove(dna);
+    }
+    m_workers[s]->run([&](){ output = m_shards[s]->remove(dna); });
+    return output;
+}
+
+// Name:    onCaller
+// Desc:    Checks if the next single insert or remove on shard s can skip its worker
+// Precon:  No batch is in progress
+// Postcon: Returns true if the operation cannot start a rehash, the only time a shard
+//          allocates a table, so running it on the calling thread leaves placement unchanged
+//          An ongoing rehash only moves DNA into the table its worker already allocated
+bool ShardedDnaDb::onCaller(int s, bool inserting) const{
+    DnaDb* shard = m_shards[s];
+    if(shard->m_oldTable != nullptr){
+        return true;
+    }else if(inserting){
+        // insert starts a rehash once lambda() passes .5
+        return 2 * (shard->m_currentSize + 1) <= shard->m_currentCap;
+    }else{
+        // remove starts a rehash once deletedRatio() passes .8
+        return 5 * (shard->m_currNumDeleted + 1) <= 4 * shard->m_currentSize;
+    }
+}
+
+// Name:    insert
+// Desc:    Inserts size DNA from arr
+// Precon:  None
+// Postcon: Every DNA will be inserted by the worker serving its shard
+//          Returns the number of DNA inserted
+int ShardedDnaDb::insert(DNA arr[], int size){
+    return batch(arr, size, true);
+}
+
+// Name:    remove
+// Desc:    Removes size DNA in arr
+// Precon:  None
+// Postcon: Every DNA will be removed by the worker serving its shard
+//          Returns the number of DNA removed
+int ShardedDnaDb::remove(DNA arr[], int size){
+    return batch(arr, size, false);
+}
+
+// Name:    batch
+// Desc:    Routes size DNA from arr to their shards and applies them in parallel
+// Precon:  None
+// Postcon: arr is bucketed by shard, then the worker of every non-empty shard inserts
+//          (or removes) its bucket in arr order
+//          Returns the number of DNA changed
+int ShardedDnaDb::batch(DNA arr[], int size, bool inserting){
+    vector<int> shard(size), start(m_numShards + 1, 0), order(size), changed(m_numShards, 0);
+    for(int i = 0; i < size; i++){
+        shard[i] = shardOf(arr[i].getSequence());
+        start[shard[i] + 1]++;
+    }
+    for(int s = 0; s < m_numShards; s++){
+        start[s + 1] += start[s];
+    }
+    vector<int> next(start.begin(), start.end() - 1);
+    for(int i = 0; i < size; i++){
+        order[next[shard[i]]++] = i;
+    }
+    for(int s = 0; s < m_numShards; s++){
+        if(start[s] != start[s + 1]){
+            m_workers[s]->post([&, s](){
+                for(int i = start[s]; i < start[s + 1]; i++){
+                    if(inserting ? m_shards[s]->insert(arr[order[i]]) : m_shards[s]->remove(arr[order[i]])){
+                        changed[s]++;
+                    }
+                }
+            });
+        }
+    }
+    int output = 0;
+    for(int s = 0; s < m_numShards; s++){
+        m_workers[s]->wait();
+        output += changed[s];
+    }
+    return output;
+}
+
+// Name:    getDNA
+// Desc:    Finds a DNA within the shard that owns sequence
+// Precon:  DNA must be within the ShardedDnaDb else returns EMPTY
+// Postcon: Returns the DNA that has the m_sequence sequence and m_location location
+//          The lookup never allocates a table, so it runs on the calling thread
+DNA ShardedDnaDb::getDNA(string sequence, int location){
+    return m_shards[shardOf(sequence)]->getDNA(sequence, location);
+}
+
+// Name:    lambda
+// Desc:    Finds the load factor across the current tables of all shards
+// Precon:  None
+// Postcon: Returns the total size over the total capacity of the shards' current tables
+float ShardedDnaDb::lambda() const{
+    unsigned long long size = 0, cap = 0;
+    for(int s = 0; s < m_numShards; s++){
+        size += m_shards[s]->m_currentSize;
+        cap += m_shards[s]->m_currentCap;
+    }
+    return (float) size / cap;
+}
+
+// Name:    deletedRatio
+// Desc:    Finds the ratio of deleted DNA across the current tables of all shards
+// Precon:  None
+// Postcon: Returns the total deleted DNA over the total non-empty DNA of the shards' current tables
+float ShardedDnaDb::deletedRatio() const{
+    unsigned long long deleted = 0, size = 0;
+    for(int s = 0; s < m_numShards; s++){
+        deleted += m_shards[s]->m_currNumDeleted;
+        size += m_shards[s]->m_currentSize;
+    }
+    return (float) deleted / size;
+}
+
+// Name:    dump
+// Desc:    Outputs a visualization of every shard in shard order
+// Precon:  None
+// Postcon: Contents of the ShardedDnaDb displayed to user
+void ShardedDnaDb::dump() const{
+    for(int s = 0; s < m_numShards; s++){
+        cout << "Dump for shard " << s << ":\n";
+        m_shards[s]->dump();
+    }
+}
+
+// Name:    ShardWorker (Constructor)
+// Desc:    Constructor for ShardWorker
+// Precon:  None
+// Postcon: A worker thread is started and bound to the NUMA node of shard,
+//          then a DnaDb of size buckets is allocated on it
+ShardWorker::ShardWorker(int shard, int size, hash_fn hash) : m_db(nullptr), m_pending(false), m_stop(false){
+    m_thread = thread(&ShardWorker::serve, this, shard);
+    run([this, size, hash](){ m_db = new DnaDb(size, hash); });
+}
+
+// Name:    ~ShardWorker (Destructor)
+// Desc:    Destructor for ShardWorker
+// Precon:  None
+// Postcon: The DnaDb is deallocated on the worker thread, which is then stopped and joined
+ShardWorker::~ShardWorker(){
+    run([this](){ delete m_db; });
+    {
+        lock_guard<mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_changed.notify_all();
+    m_thread.join();
+}
+
+// Name:    getDb
+// Desc:    Gettor for m_db
+// Precon:  None
+// Postcon: Returns the DnaDb served by the worker
+DnaDb* ShardWorker::getDb() const{
+    return m_db;
+}
+
+// Name:    post
+// Desc:    Hands a task to the worker thread
+// Precon:  None
+// Postcon: Waits for any earlier task to finish, then task is queued to run on the worker
+void ShardWorker::post(function<void()> task){
+    unique_lock<mutex> guard(m_lock);
+    m_changed.wait(guard, [this](){ return !m_pending; });
+    m_task = task;
+    m_pending = true;
+    m_changed.notify_all();
+}
+
+// Name:    wait
+// Desc:    Waits for the posted task
+// Precon:  None
+// Postcon: Returns once no task is waiting or running
+void ShardWorker::wait(){
+    unique_lock<mutex> guard(m_lock);
+    m_changed.wait(guard, [this](){ return !m_pending; });
+}
+
+// Name:    run
+// Desc:    Runs a task on the worker thread
+// Precon:  None
+// Postcon: task has run on the worker
+void ShardWorker::run(function<void()> task){
+    post(task);
+    wait();
+}
+
+// Name:    serve
+// Desc:    Body of the worker thread
+// Precon:  None
+// Postcon: Binds to the NUMA node of shard, then runs posted tasks one at a time until stopped
+void ShardWorker::serve(int shard){
+    ShardedDnaDb::bindShard(shard);
+    unique_lock<mutex> guard(m_lock);
+    while(true){
+        m_changed.wait(guard, [this](){ return m_pending || m_stop; });
+        if(!m_pending){
+            return;
+        }
+        guard.unlock();
+        m_task();
+        guard.lock();
+        m_pending = false;
+        m_changed.notify_all();
+    }
+}
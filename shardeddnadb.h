@@ -0,0 +1,80 @@
+// Sharded front end for DnaDb
+#ifndef SHARDEDDNADB_H
+#define SHARDEDDNADB_H
+#include "dnadb.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+const int MAXSHARDS = 64;   // Max number of shards
+
+class ShardWorker{
+    public:
+    ShardWorker(int shard, int size, hash_fn hash);
+    // a worker owns its thread and its DnaDb, so it cannot be copied
+    ShardWorker(const ShardWorker& rhs) = delete;
+    ~ShardWorker();
+    const ShardWorker& operator=(const ShardWorker& rhs) = delete;
+    DnaDb* getDb() const;
+    // hands task to the worker thread, waiting for any earlier task to be taken
+    void post(function<void()> task);
+    // waits until the posted task has run
+    void wait();
+    // posts task and waits for it
+    void run(function<void()> task);
+
+    private:
+    DnaDb*                  m_db;       // shard owned and served by m_thread
+    thread                  m_thread;   // worker bound to the shard's NUMA node
+    mutex                   m_lock;     // guards m_task, m_pending and m_stop
+    condition_variable      m_changed;  // signalled when a task is posted or finished
+    function<void()>        m_task;     // task waiting to run or running
+    bool                    m_pending;  // true until m_task has run
+    bool                    m_stop;     // true once the worker should exit
+
+    //private helper functions
+    void serve(int shard);
+};
+
+class ShardedDnaDb{
+    public:
+    friend class Grader;
+    friend class Tester;
+    ShardedDnaDb(int numShards, int size, hash_fn hash);
+    // the shards are owned by their workers' threads, so a ShardedDnaDb cannot be copied
+    ShardedDnaDb(const ShardedDnaDb& rhs) = delete;
+    ~ShardedDnaDb();
+    const ShardedDnaDb& operator=(const ShardedDnaDb& rhs) = delete;
+    // Returns Load factor across the new tables of all shards
+    float lambda() const;
+    // Returns the ratio of deleted slots across the new tables of all shards
+    float deletedRatio() const;
+    // Like a DnaDb, a ShardedDnaDb must be used from one thread at a time
+    // insert and remove run on the calling thread unless they could start a rehash,
+    // then on the worker of the shard owning the sequence, getDNA always runs on the caller
+    bool insert(DNA dna);
+    bool remove(DNA dna);
+    // batched operations run on every shard's worker in parallel, return the number changed
+    // prefer them when applying many DNA, only they spread the work across shards
+    int insert(DNA arr[], int size);
+    int remove(DNA arr[], int size);
+    DNA getDNA(string sequence, int location);
+    void dump() const;
+
+    private:
+    hash_fn     m_hash;         // hash function used for routing and by every shard
+    DnaDb**         m_shards;   // array of shards
+    ShardWorker**   m_workers;  // worker serving each shard
+    int             m_numShards;// number of shards
+
+    //private helper functions
+    int shardOf(const string& sequence) const;
+    int batch(DNA arr[], int size, bool inserting);
+    bool onCaller(int s, bool inserting) const;
+
+    friend class ShardWorker;
+    static bool readList(string path, vector<int>& ids);
+    static void bindShard(int shard);
+};
+#endif